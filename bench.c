@@ -0,0 +1,426 @@
+#define _GNU_SOURCE  // strptime()
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>  //getopt()
+
+// count every allocation made by the code under test
+long n_allocs = 0;
+
+void *counting_malloc(size_t size) {
+    n_allocs++;
+    return malloc(size);
+}
+
+void *counting_calloc(size_t count, size_t size) {
+    n_allocs++;
+    return calloc(count, size);
+}
+
+void *counting_realloc(void *ptr, size_t size) {
+    n_allocs++;
+    return realloc(ptr, size);
+}
+
+#define malloc(size) counting_malloc(size)
+#define calloc(count, size) counting_calloc(count, size)
+#define realloc(ptr, size) counting_realloc(ptr, size)
+#include "hash_table.h"
+#include "parser.h"
+#include "queue.h"
+#undef malloc
+#undef calloc
+#undef realloc
+
+#define PROG "bench"
+#define HOST "comp3310.ddns.net"
+#define CORPUS_DIR "corpus"
+#define MAX_RESPONSES 256
+#define MAX_RESULTS 64
+#define KEYLEN 16
+#define LOOKUP_WORK 100000000L  // bound on items compared by a lookup run
+#define MAX_EXP 7  // 10^7 elements already take a few GB
+
+
+/* ----- response corpus ----- */
+
+typedef struct Response {
+    char *link;      // path that was requested
+    char *response;  // raw response, NUL-terminated
+    long len;
+    long head_len;  // status line and headers, including the blank line
+} Response;
+
+Response corpus[MAX_RESPONSES];
+int corpus_size = 0;
+
+Ref_Buffer scratch = {NULL, 0};  // reused by every extract_refs() call
+
+// every path found in the corpus, fed to hash_djb2
+char **corpus_links = NULL;
+int n_corpus_links = 0;
+int cap_corpus_links = 0;
+
+// each file holds the request line the crawler would send, a blank line and
+// the raw response bytes
+void load_corpus(char *dir) {
+    DIR *d = opendir(dir);
+    struct dirent *ent;
+    char path[1024];
+
+    if (d == NULL) {
+        perror(dir);
+        exit(1);
+    }
+    while ((ent = readdir(d)) != NULL && corpus_size < MAX_RESPONSES) {
+        if (ent->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        FILE *fp = fopen(path, "rb");
+        if (fp == NULL) {
+            perror(path);
+            exit(1);
+        }
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        char *raw = malloc(size + 1);
+        if (fread(raw, 1, size, fp) != (size_t)size) {
+            printf("%s: cannot read %s\n", PROG, path);
+            exit(1);
+        }
+        raw[size] = 0;
+        fclose(fp);
+
+        char *lp = raw + strlen("GET ");
+        char *rp = strchr(lp, ' ');
+        char *sp = strstr(raw, "\r\n\r\n");
+        if (strncmp(raw, "GET ", 4) != 0 || rp == NULL || sp == NULL) {
+            printf("%s: %s is not a corpus response\n", PROG, path);
+            exit(1);
+        }
+        Response *rec = &corpus[corpus_size++];
+        rec->link = strndup(lp, rp - lp);
+        sp += strlen("\r\n\r\n");
+        rec->len = size - (sp - raw);
+        rec->response = malloc(rec->len + 1);
+        memcpy(rec->response, sp, rec->len + 1);
+        char *body = strstr(rec->response, "\r\n\r\n");
+        rec->head_len = body != NULL ? body - rec->response + 4 : rec->len;
+        free(raw);
+    }
+    closedir(d);
+
+    if (corpus_size == 0) {
+        printf("%s: no responses in %s\n", PROG, dir);
+        exit(1);
+    }
+}
+
+void keep_link(void *ctx, int kind, char *path, char *host, int port) {
+    if (n_corpus_links == cap_corpus_links) {
+        cap_corpus_links = cap_corpus_links ? cap_corpus_links * 2 : 256;
+        corpus_links =
+            realloc(corpus_links, cap_corpus_links * sizeof(char *));
+    }
+    corpus_links[n_corpus_links++] = strdup(path);
+}
+
+void count_ref(void *ctx, int kind, char *path, char *host, int port) {
+    (*(long *)ctx)++;
+}
+
+/* ----- timing and results ----- */
+
+typedef struct Result {
+    char *name;
+    long n;      // elements in the structure, or 0 for parser benchmarks
+    long ops;
+    long bytes;  // bytes processed, or 0 if it doesn't apply
+    long allocs;
+    double ns;
+} Result;
+
+Result results[MAX_RESULTS];
+int n_results = 0;
+
+double min_seconds = 0.5;  // parser benchmarks repeat the corpus this long
+char *commit = "unknown";  // labels the results, see -g
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+Result *begin_result(char *name, long n) {
+    Result *res = &results[n_results++];
+    bzero(res, sizeof(Result));
+    res->name = name;
+    res->n = n;
+    res->allocs = n_allocs;
+    res->ns = now_ns();
+    return res;
+}
+
+void end_result(Result *res, long ops, long bytes) {
+    res->ns = now_ns() - res->ns;
+    res->allocs = n_allocs - res->allocs;
+    res->ops = ops;
+    res->bytes = bytes;
+
+    printf("%-24s %10ld %12.1f %12.1f %10.2f\n", res->name, res->n,
+           res->ns / res->ops,
+           res->bytes ? res->bytes / (res->ns / 1e9) / 1e6 : 0.0,
+           (double)res->allocs / res->ops);
+}
+
+void write_json(char *path) {
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        perror(path);
+        exit(1);
+    }
+    fprintf(fp, "{\n  \"commit\": \"%s\",\n  \"timestamp\": %ld,\n",
+            commit, (long)time(NULL));
+    fprintf(fp, "  \"corpus_responses\": %d,\n  \"results\": [\n",
+            corpus_size);
+    for (int i = 0; i < n_results; ++i) {
+        Result *res = &results[i];
+        fprintf(fp,
+                "    {\"name\": \"%s\", \"n\": %ld, \"ops\": %ld, "
+                "\"ns_per_op\": %.2f, \"bytes_per_sec\": %.0f, "
+                "\"allocs_per_op\": %.4f}%s\n",
+                res->name, res->n, res->ops, res->ns / res->ops,
+                res->bytes ? res->bytes / (res->ns / 1e9) : 0.0,
+                (double)res->allocs / res->ops,
+                i + 1 < n_results ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+}
+
+/* ----- benchmarks ----- */
+
+// status line, Last-Modified, Content-Length and Location of every response;
+// MB/s is over the header block of each response
+void bench_headers() {
+    long ops = 0, bytes = 0, sink = 0;
+    double deadline = now_ns() + min_seconds * 1e9;
+    Result *res = begin_result("parse_headers", 0);
+
+    do {
+        for (int i = 0; i < corpus_size; ++i) {
+            char *sp = corpus[i].response;
+            time_t t;
+            int statusFlag = parse_status(&sp);
+            if (statusFlag == 2) {
+                if (parse_last_modified(&sp, &t) == 0) {
+                    sink += t;
+                }
+                sink += parse_content_length(&sp);
+            } else if (statusFlag == 3) {
+                size_t len = 0;
+                if (parse_location(sp, &len) != NULL) {
+                    sink += len;
+                }
+            }
+            sink += statusFlag;
+            bytes += corpus[i].head_len;
+        }
+        ops += corpus_size;
+    } while (now_ns() < deadline);
+
+    end_result(res, ops, bytes);
+    if (sink == 0) {
+        printf("%s: parsed nothing\n", PROG);
+    }
+}
+
+// links and images of every page, handled by a callback that only counts
+void bench_extract() {
+    long ops = 0, bytes = 0, refs = 0;
+    double deadline = now_ns() + min_seconds * 1e9;
+    Result *res = begin_result("extract_refs", 0);
+
+    do {
+        for (int i = 0; i < corpus_size; ++i) {
+            char *sp = corpus[i].response;
+            if (parse_status(&sp) != 4) {
+                extract_refs(sp, corpus[i].link, HOST, &scratch, count_ref,
+                             &refs);
+            }
+            bytes += corpus[i].len;
+        }
+        ops += corpus_size;
+    } while (now_ns() < deadline);
+
+    end_result(res, ops, bytes);
+}
+
+void bench_hash() {
+    long ops = 0, passes = 0, pass_bytes = 0;
+    unsigned long sink = 0;
+
+    // the same every pass, so kept out of the timed loop
+    for (int i = 0; i < n_corpus_links; ++i) {
+        pass_bytes += strlen(corpus_links[i]);
+    }
+
+    double deadline = now_ns() + min_seconds * 1e9;
+    Result *res = begin_result("hash_djb2", 0);
+
+    do {
+        for (int i = 0; i < n_corpus_links; ++i) {
+            sink += hash_djb2(corpus_links[i]);
+        }
+        ops += n_corpus_links;
+        passes++;
+    } while (now_ns() < deadline);
+
+    end_result(res, ops, passes * pass_bytes);
+    if (sink == 0) {
+        printf("%s: hashed nothing\n", PROG);
+    }
+}
+
+// fixed-width keys so n of them can live in a single block
+char *make_keys(long n) {
+    char *keys = malloc(n * KEYLEN);
+    for (long i = 0; i < n; ++i) {
+        snprintf(keys + i * KEYLEN, KEYLEN, "/%09u.htm", (unsigned)i);
+    }
+    return keys;
+}
+
+// visited set: n inserts, then lookups against the full table
+void bench_visited(long n, char *keys) {
+    Pseudo_HashTable *table = init_table(n);
+    long bytes = 0;
+
+    Result *res = begin_result("visited_insert", n);
+    for (long i = 0; i < n; ++i) {
+        insert(table, keys + i * KEYLEN);
+        bytes += KEYLEN - 1;
+    }
+    end_result(res, n, bytes);
+
+    // search() is a linear scan, so bound the total work at large n
+    long lookups = LOOKUP_WORK / n;
+    if (lookups > n) {
+        lookups = n;
+    }
+    if (lookups < 16) {
+        lookups = 16;
+    }
+    long found = 0;
+    unsigned long stride = 2654435761UL;  // spread lookups over the table
+    res = begin_result("visited_lookup", n);
+    for (long i = 0; i < lookups; ++i) {
+        char *key = keys + ((i * stride) % n) * KEYLEN;
+        if (search(table, hash_djb2(key)) != NULL) {
+            found++;
+        }
+    }
+    end_result(res, lookups, 0);
+    if (found != lookups) {
+        printf("%s: visited set lost %ld keys\n", PROG, lookups - found);
+    }
+
+    free_table(table);
+}
+
+// frontier: fill the queue with n links, then drain it
+void bench_frontier(long n, char *keys) {
+    Queue *queue = init_queue(n);
+
+    Result *res = begin_result("frontier_push", n);
+    for (long i = 0; i < n; ++i) {
+        enqueue(queue, keys + i * KEYLEN);
+    }
+    end_result(res, n, n * (KEYLEN - 1));
+
+    res = begin_result("frontier_pop", n);
+    while (!isEmpty(queue)) {
+        free(dequeue(queue));
+    }
+    end_result(res, n, n * (KEYLEN - 1));
+
+    free_queue(queue);
+}
+
+int main(int argc, char *argv[]) {
+    char *corpus_dir = CORPUS_DIR;
+    char *json_path = NULL;
+    int min_exp = 3, max_exp = 7;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:o:m:t:g:")) != -1) {
+        switch (opt) {
+            case 'c':
+                corpus_dir = optarg;
+                break;
+            case 'o':
+                json_path = optarg;
+                break;
+            case 'm':
+                max_exp = atoi(optarg);
+                break;
+            case 't':
+                min_seconds = atof(optarg);
+                break;
+            case 'g':
+                commit = optarg;
+                break;
+            default:
+                printf(
+                    "Usage: ./bench [-c corpus_dir] [-o results.json] "
+                    "[-m max_exponent] [-t min_seconds] [-g commit]\n");
+                exit(1);
+        }
+    }
+    if (max_exp < min_exp || max_exp > MAX_EXP) {
+        printf("%s: max exponent must be within [%d, %d]\n", PROG, min_exp,
+               MAX_EXP);
+        exit(1);
+    }
+
+    load_corpus(corpus_dir);
+    for (int i = 0; i < corpus_size; ++i) {
+        char *sp = corpus[i].response;
+        if (parse_status(&sp) != 4) {
+            extract_refs(sp, corpus[i].link, HOST, &scratch, keep_link, NULL);
+        }
+    }
+    printf("%s: %d corpus responses, %d links, commit %s\n\n", PROG,
+           corpus_size, n_corpus_links, commit);
+
+    printf("%-24s %10s %12s %12s %10s\n", "benchmark", "n", "ns/op", "MB/s",
+           "allocs/op");
+    bench_headers();
+    bench_extract();
+    bench_hash();
+
+    for (int e = min_exp; e <= max_exp; ++e) {
+        long n = 1;
+        for (int i = 0; i < e; ++i) {
+            n *= 10;
+        }
+        char *keys = make_keys(n);
+        bench_visited(n, keys);
+        bench_frontier(n, keys);
+        free(keys);
+    }
+
+    if (json_path != NULL) {
+        write_json(json_path);
+        printf("\n%s: results written to %s\n", PROG, json_path);
+    }
+
+    return 0;
+}
@@ -0,0 +1,273 @@
+#define _GNU_SOURCE  // open_memstream(), strndup()
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libcrawler.h"
+
+#define PROG "check_crawler"
+#define HOST "comp3310.ddns.net"
+#define CORPUS_DIR "corpus"
+#define MAX_HOSTS 64
+#define HUGE_HREF (1L << 20)
+
+// redirects of the corpus, as they must appear in the JSONL
+const char *expected_redirects[] = {
+    "{\"type\":\"redirect\",\"from\":\"/moved.html\","
+    "\"to\":\"http://comp3310.ddns.net:7880/B/page3.html\"}\n",
+    "{\"type\":\"redirect\",\"from\":\"/A/old.html\","
+    "\"to\":\"http://comp3310.ddns.net:7880/A/page1.html\"}\n",
+};
+
+// the JSONL of every event goes to out, besides what is counted here
+typedef struct Events {
+    FILE *out;
+    int n_refs;  // edges and off-site links
+    long longest_edge;
+    char *hosts[MAX_HOSTS];  // off-site hosts seen so far
+    int n_hosts;
+    int bad_first_seen;
+} Events;
+
+int failures = 0;
+
+void fail(const char *name, const char *what) {
+    printf("%s: %s: %s\n", PROG, name, what);
+    failures++;
+}
+
+void on_page(void *user, const crawler_page_t *page) {
+    crawler_jsonl_page(((Events *)user)->out, page);
+}
+
+void on_edge(void *user, const crawler_edge_t *edge) {
+    Events *events = (Events *)user;
+    long len = strlen(edge->to);
+
+    events->n_refs++;
+    if (len > events->longest_edge) {
+        events->longest_edge = len;
+    }
+    crawler_jsonl_edge(events->out, edge);
+}
+
+void on_redirect(void *user, const crawler_redirect_t *redirect) {
+    crawler_jsonl_redirect(((Events *)user)->out, redirect);
+}
+
+void on_not_found(void *user, const char *path) {
+    crawler_jsonl_not_found(((Events *)user)->out, path);
+}
+
+// first_seen must be set for the first link to each host, and only for it
+void on_offsite(void *user, const crawler_offsite_t *offsite) {
+    Events *events = (Events *)user;
+    bool seen = false;
+
+    events->n_refs++;
+    for (int i = 0; i < events->n_hosts; ++i) {
+        if (strcmp(events->hosts[i], offsite->host) == 0) {
+            seen = true;
+        }
+    }
+    if (!seen && events->n_hosts < MAX_HOSTS) {
+        events->hosts[events->n_hosts++] = strdup(offsite->host);
+    }
+    if (offsite->first_seen == seen) {
+        events->bad_first_seen++;
+    }
+    crawler_jsonl_offsite(events->out, offsite);
+}
+
+int count(const char *str, const char *sub) {
+    int n = 0;
+    for (const char *p = strstr(str, sub); p != NULL; p = strstr(p + 1, sub)) {
+        n++;
+    }
+    return n;
+}
+
+// true if the JSONL in lines has line, newline included
+bool has_line(const char *lines, const char *line) {
+    for (const char *p = lines; p != NULL; p = strchr(p, '\n')) {
+        p += *p == '\n';
+        if (strncmp(p, line, strlen(line)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ----- replay the corpus -----
+ * each file holds the request line the crawler would send, a blank line and
+ * the raw response; its name starts with the status the response has */
+void check_response(crawler_t *crawler, Events *events, char **jsonl,
+                    const char *name, char *raw) {
+    char *lp = raw + strlen("GET ");
+    char *rp = strchr(lp, ' ');
+    char *sp = strstr(raw, "\r\n\r\n");
+    if (strncmp(raw, "GET ", 4) != 0 || rp == NULL || sp == NULL) {
+        fail(name, "not a corpus response");
+        return;
+    }
+    char *link = strndup(lp, rp - lp);
+    sp += strlen("\r\n\r\n");
+
+    long start = ftell(events->out);
+    events->n_refs = 0;
+    if (crawler_parse(crawler, link, sp, strlen(sp)) < 0) {
+        fail(name, crawler_error(crawler));
+        free(link);
+        return;
+    }
+    fflush(events->out);
+    char *lines = *jsonl + start;
+    char line[1024];
+
+    snprintf(line, sizeof(line),
+             "{\"type\":\"page\",\"path\":\"%s\",\"status\":%d,", link,
+             atoi(name));
+    if (strncmp(lines, line, strlen(line)) != 0) {
+        fail(name, "the first event is not the page with its status");
+    }
+    if (atoi(name) == 404) {
+        snprintf(line, sizeof(line),
+                 "{\"type\":\"not_found\",\"path\":\"%s\"}\n", link);
+        if (!has_line(lines, line) || count(lines, "\n") != 2) {
+            fail(name, "a 404 is not reported as a page and not_found only");
+        }
+    } else if (events->n_refs !=
+               count(sp, "<a href=\"") + count(sp, "<img src=\"")) {
+        fail(name, "not every link and image is reported");
+    }
+
+    char *location = strstr(sp, "\r\nLocation: ");
+    if (atoi(name) / 100 == 3 && location != NULL) {
+        location += strlen("\r\nLocation: ");
+        size_t len = strcspn(location, "\r\n");
+        snprintf(line, sizeof(line),
+                 "{\"type\":\"redirect\",\"from\":\"%s\",\"to\":\"%.*s\"}\n",
+                 link, (int)len, location);
+        if (!has_line(lines, line)) {
+            fail(name, "the redirect does not go to the Location header");
+        }
+    }
+    free(link);
+}
+
+void check_corpus(crawler_t *crawler, Events *events, char **jsonl,
+                  const char *dir) {
+    struct dirent **ents;
+    char path[1024];
+    int n = scandir(dir, &ents, NULL, alphasort);  // the order first_seen sees
+
+    if (n < 0) {
+        perror(dir);
+        exit(1);
+    }
+    for (int i = 0; i < n; ++i) {
+        char *name = ents[i]->d_name;
+        if (name[0] == '.') {
+            free(ents[i]);
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        FILE *fp = fopen(path, "rb");
+        if (fp == NULL) {
+            perror(path);
+            exit(1);
+        }
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        char *raw = malloc(size + 1);
+        if (fread(raw, 1, size, fp) != (size_t)size) {
+            printf("%s: cannot read %s\n", PROG, path);
+            exit(1);
+        }
+        raw[size] = 0;
+        fclose(fp);
+
+        check_response(crawler, events, jsonl, name, raw);
+        free(raw);
+        free(ents[i]);
+    }
+    free(ents);
+
+    if (events->bad_first_seen > 0) {
+        fail(dir, "first_seen is wrong for some off-site links");
+    }
+    fflush(events->out);
+    for (int i = 0; i < sizeof(expected_redirects) / sizeof(char *); ++i) {
+        if (!has_line(*jsonl, expected_redirects[i])) {
+            fail(dir, "a known redirect is missing from the JSONL");
+        }
+    }
+}
+
+// an href far longer than any buffer on the stack is passed on whole, and
+// one cut off by the end of the response is dropped
+void check_huge_href(crawler_t *crawler, Events *events) {
+    const char *head = "HTTP/1.1 200 OK\r\n\r\n<a href=\"/";
+    const char *tail = "\">x</a><img src=\"cut";
+    long len = strlen(head) + HUGE_HREF + strlen(tail);
+    char *response = malloc(len + 1);
+
+    strcpy(response, head);
+    memset(response + strlen(head), 'x', HUGE_HREF);
+    strcpy(response + strlen(head) + HUGE_HREF, tail);
+
+    events->n_refs = 0;
+    events->longest_edge = 0;
+    if (crawler_parse(crawler, "/huge.html", response, len) < 0) {
+        fail("huge href", crawler_error(crawler));
+    } else if (events->n_refs != 1 || events->longest_edge != HUGE_HREF + 1) {
+        fail("huge href", "the link is not passed on whole");
+    }
+    free(response);
+}
+
+int main(int argc, char *argv[]) {
+    // expected command line input:
+    // ./check_crawler [corpus_dir]
+    const char *dir = argc > 1 ? argv[1] : CORPUS_DIR;
+    char *jsonl = NULL;
+    size_t jsonl_len = 0;
+    Events events = {0};
+
+    events.out = open_memstream(&jsonl, &jsonl_len);
+    crawler_config_t config;
+    crawler_config_init(&config);
+    config.host_name = HOST;
+    config.callbacks.on_page = on_page;
+    config.callbacks.on_edge = on_edge;
+    config.callbacks.on_redirect = on_redirect;
+    config.callbacks.on_not_found = on_not_found;
+    config.callbacks.on_offsite = on_offsite;
+    config.callbacks.user = &events;
+
+    crawler_t *crawler = crawler_new(&config);
+    if (events.out == NULL || crawler == NULL) {
+        printf("%s: cannot create the crawler\n", PROG);
+        exit(2);
+    }
+    check_corpus(crawler, &events, &jsonl, dir);
+    check_huge_href(crawler, &events);
+
+    crawler_free(crawler);
+    fclose(events.out);
+    free(jsonl);
+    for (int i = 0; i < events.n_hosts; ++i) {
+        free(events.hosts[i]);
+    }
+
+    if (failures > 0) {
+        printf("%s: %d check(s) failed\n", PROG, failures);
+        return 1;
+    }
+    printf("%s: ok\n", PROG);
+    return 0;
+}
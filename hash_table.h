@@ -7,7 +7,7 @@
  *    Availability: http://www.cse.yorku.ca/~oz/hash.html
  *
  ************************************************************/
-unsigned long hash_djb2(char *str) {
+static unsigned long hash_djb2(char *str) {
     unsigned long hash = 5381;
     int c;
 
@@ -29,21 +29,36 @@ typedef struct Pseudo_HashTable { // a "hash table" that can tolerate duplicate
     int current_available;
 } Pseudo_HashTable; 
 
-Item *create_item(unsigned long hash_key, char *link) {
+static Item *create_item(unsigned long hash_key, char *link) {
     Item *item = (Item *)malloc(sizeof(Item));
+    if (item == NULL) {
+        return NULL;
+    }
     item->hash_key = hash_key;
     item->value = (char *)malloc(strlen(link) + 1);
+    if (item->value == NULL) {
+        free(item);
+        return NULL;
+    }
     strcpy(item->value, link);
 
     return item;
 }
 
-Pseudo_HashTable *init_table(int size) {
+// returns NULL if out of memory
+static Pseudo_HashTable *init_table(int size) {
     Pseudo_HashTable *table = (Pseudo_HashTable *)malloc(sizeof(Pseudo_HashTable));
+    if (table == NULL) {
+        return NULL;
+    }
 
     table->capacity = size;
     table->current_available = 0;
     table->items = (Item **)calloc(table->capacity, sizeof(Item *));
+    if (table->items == NULL) {
+        free(table);
+        return NULL;
+    }
 
     for (int i = 0; i < table->capacity; ++i) {
         table->items[i] = NULL;
@@ -52,12 +67,12 @@ Pseudo_HashTable *init_table(int size) {
     return table;
 }
 
-void free_item(Item *item) {
+static void free_item(Item *item) {
     free(item->value);
     free(item);
 }
 
-void free_table(Pseudo_HashTable *table) {
+static void free_table(Pseudo_HashTable *table) {
     for (int i = 0; i < table->capacity; ++i) {
         Item *item = table->items[i];
         if (item != NULL) {
@@ -68,18 +83,34 @@ void free_table(Pseudo_HashTable *table) {
     free(table);
 }
 
-void insert(Pseudo_HashTable *table, char *link) {
+// returns -1 if out of memory, the table is left unchanged then
+static int insert(Pseudo_HashTable *table, char *link) {
     unsigned long local_hash = hash_djb2(link);
-    Item *item = create_item(local_hash, link);
     int cur = table->current_available;
 
-    if (table->current_available < table->capacity) {
-        table->items[cur] = item;
-        table->current_available++;
+    if (table->current_available == table->capacity) {  // full, double it
+        int capacity = table->capacity > 0 ? table->capacity * 2 : 1;
+        Item **items =
+            (Item **)realloc(table->items, capacity * sizeof(Item *));
+        if (items == NULL) {
+            return -1;
+        }
+        table->items = items;
+        table->capacity = capacity;
+        for (int i = cur; i < table->capacity; ++i) {
+            table->items[i] = NULL;
+        }
+    }
+    Item *item = create_item(local_hash, link);
+    if (item == NULL) {
+        return -1;
     }
+    table->items[cur] = item;
+    table->current_available++;
+    return 0;
 }
 
-char *search(Pseudo_HashTable *table, unsigned long hash_key) {
+static char *search(Pseudo_HashTable *table, unsigned long hash_key) {
     char *res = NULL;
     for (int i = 0; i < table->current_available; ++i) {
         if (table->items[i]->hash_key == hash_key) {
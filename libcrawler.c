@@ -0,0 +1,687 @@
+#define _GNU_SOURCE  // strptime(), timegm()
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>  //getaddrinfo()
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>  //close()
+
+#include "hash_table.h"
+#include "libcrawler.h"
+#include "parser.h"
+#include "queue.h"
+
+#define PORT "80"
+#define HEADLEN 256  // request line and headers, besides the path
+#define BUFLEN 256
+#define MSGLEN 16384
+#define LINK_COUNT 512  // initial size of the tables, they grow as needed
+#define DELAY_MS 500
+#define MAX_RESPONSE (8L << 20)  // cut responses off at 8 MiB by default
+#define OFFSITE_TIMEOUT 5  // seconds to wait for an off-site host to answer
+#define PENDING_COUNT 16
+
+typedef struct Buffer {  // grows to fit the largest response
+    char *data;
+    long cap;
+    long len;
+} Buffer;
+
+typedef struct Offsite {  // off-site link waiting to be reported
+    char *host;
+    int port;
+    char *path;
+    bool first_seen;
+} Offsite;
+
+struct crawler_t {
+    crawler_config_t config;
+    char *host_name;
+    char *port;
+    struct addrinfo hints;
+
+    /* ----- data structures for collecting information ----- */
+    Pseudo_HashTable *page_table;
+    Pseudo_HashTable *img_table;
+    Pseudo_HashTable *offsite_host_table;
+    Pseudo_HashTable *valid_host_table;  // off-site hosts that answered
+    Queue *queue;  // for BFS
+
+    bool is_initial_request;
+    Buffer response;
+    Buffer head;  // replies of off-site hosts, checked while parsing
+    Ref_Buffer scratch;  // paths handed out by extract_refs()
+
+    // state of the page being parsed
+    char *link;
+    int status_flag;
+    char *redirect_dest;
+    bool out_of_memory;  // set by handle_ref(), which cannot fail the step
+    Offsite *pending;  // off-site links of this page
+    int n_pending;
+    int cap_pending;
+
+    char error[BUFLEN];
+};
+
+void crawler_config_init(crawler_config_t *config) {
+    bzero(config, sizeof(crawler_config_t));
+    config->port = PORT;
+    config->delay_ms = DELAY_MS;
+    config->max_response = MAX_RESPONSE;
+    config->check_offsite = false;
+}
+
+crawler_t *crawler_new(const crawler_config_t *config) {
+    if (config->host_name == NULL) {
+        return NULL;
+    }
+    crawler_t *crawler = (crawler_t *)calloc(1, sizeof(crawler_t));
+    if (crawler == NULL) {
+        return NULL;
+    }
+
+    crawler->config = *config;
+    crawler->host_name = strdup(config->host_name);
+    crawler->port = strdup(config->port != NULL ? config->port : PORT);
+    if (crawler->host_name == NULL || crawler->port == NULL) {
+        crawler_free(crawler);
+        return NULL;
+    }
+
+    crawler->hints.ai_family = AF_INET;        // IPv4; for IPv6, use AF_INET6
+    crawler->hints.ai_socktype = SOCK_STREAM;  // for TCP
+    crawler->hints.ai_protocol = 0;            // any protocol
+
+    crawler->page_table = init_table(LINK_COUNT);
+    crawler->img_table = init_table(LINK_COUNT);
+    crawler->offsite_host_table = init_table(LINK_COUNT);
+    crawler->valid_host_table = init_table(LINK_COUNT);
+    crawler->queue = init_queue(LINK_COUNT);
+
+    crawler->is_initial_request = true;
+    crawler->response.cap = MSGLEN;
+    crawler->response.data = (char *)malloc(crawler->response.cap);
+    crawler->head.cap = BUFLEN * 2;
+    crawler->head.data = (char *)malloc(crawler->head.cap);
+    crawler->cap_pending = PENDING_COUNT;
+    crawler->pending =
+        (Offsite *)malloc(crawler->cap_pending * sizeof(Offsite));
+
+    if (crawler->page_table == NULL || crawler->img_table == NULL ||
+        crawler->offsite_host_table == NULL ||
+        crawler->valid_host_table == NULL || crawler->queue == NULL ||
+        crawler->response.data == NULL || crawler->head.data == NULL ||
+        crawler->pending == NULL || enqueue(crawler->queue, "/") < 0 ||
+        insert(crawler->page_table, "/") < 0) {
+        crawler_free(crawler);
+        return NULL;
+    }
+
+    return crawler;
+}
+
+void crawler_free(crawler_t *crawler) {
+    if (crawler == NULL) {
+        return;
+    }
+    Pseudo_HashTable *tables[] = {crawler->page_table, crawler->img_table,
+                                  crawler->offsite_host_table,
+                                  crawler->valid_host_table};
+    for (int i = 0; i < sizeof(tables) / sizeof(tables[0]); ++i) {
+        if (tables[i] != NULL) {
+            free_table(tables[i]);
+        }
+    }
+    if (crawler->queue != NULL) {
+        free_queue(crawler->queue);
+    }
+    free(crawler->response.data);
+    free(crawler->head.data);
+    free(crawler->scratch.data);
+    free(crawler->pending);
+    free(crawler->link);
+    free(crawler->redirect_dest);
+    free(crawler->host_name);
+    free(crawler->port);
+    free(crawler);
+}
+
+const char *crawler_error(crawler_t *crawler) { return crawler->error; }
+
+static void resourceError(crawler_t *crawler, char *caller) {
+    snprintf(crawler->error, sizeof(crawler->error), "%s: %s", caller,
+             strerror(errno));
+}
+
+static int memoryError(crawler_t *crawler) {
+    snprintf(crawler->error, sizeof(crawler->error), "out of memory");
+    return -1;
+}
+
+/* ----- networking ----- */
+
+// waits for a non-blocking connect() to finish, for at most timeout seconds
+static int wait_connected(int sockfd, int timeout) {
+    struct pollfd pfd = {sockfd, POLLOUT, 0};
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    if (poll(&pfd, 1, timeout * 1000) <= 0) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
+        return -1;
+    }
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+// returns a socket connected to host:port, or -1; timeout bounds connect()
+// in seconds if it is positive
+static int open_socket(crawler_t *crawler, const char *host,
+                       const char *port, int timeout) {
+    struct addrinfo *server;
+    int err, sockfd;
+
+    if ((err = getaddrinfo(host, port, &crawler->hints, &server))) {
+        snprintf(crawler->error, sizeof(crawler->error),
+                 "getaddrinfo %s: %s", host, gai_strerror(err));
+        return -1;
+    }
+    sockfd =
+        socket(server->ai_family, server->ai_socktype, server->ai_protocol);
+    if (sockfd < 0) {
+        resourceError(crawler, "socket");
+        freeaddrinfo(server);
+        return -1;
+    }
+    int flags = fcntl(sockfd, F_GETFL, 0);
+    if (timeout > 0) {
+        fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
+    }
+    err = connect(sockfd, server->ai_addr, server->ai_addrlen);
+    if (err < 0 && timeout > 0 && errno == EINPROGRESS) {
+        err = wait_connected(sockfd, timeout);
+    }
+    if (err == 0 && timeout > 0) {
+        err = fcntl(sockfd, F_SETFL, flags);  // blocking again for recv()
+    }
+    if (err < 0) {
+        resourceError(crawler, "connect");
+        close(sockfd);
+        freeaddrinfo(server);
+        return -1;
+    }
+    freeaddrinfo(server);
+    return sockfd;
+}
+
+static int send_request(crawler_t *crawler, int sockfd, char *request) {
+    int nbytes_total = strlen(request);
+    int nbytes_sent = 0;
+    int nbytes;
+
+    while (nbytes_sent < nbytes_total) {
+        nbytes = write(sockfd, request + nbytes_sent,
+                       nbytes_total - nbytes_sent);
+        if (nbytes < 0) {
+            resourceError(crawler, "send");
+            return -1;
+        }
+        if (nbytes == 0) {
+            break;
+        }
+        nbytes_sent += nbytes;
+    }
+    return 0;
+}
+
+// read into buf until the server closes the connection, or only until it
+// looks like an HTTP response if head_only is set; returns 1 if the response
+// was cut off at limit bytes (if limit is positive), 0 or -1 on error
+static int receive_response(crawler_t *crawler, int sockfd, Buffer *buf,
+                            bool head_only, long limit) {
+    int nbytes;
+
+    buf->len = 0;
+    buf->data[0] = 0;
+    while (true) {
+        if (limit > 0 && buf->len >= limit) {
+            return 1;
+        }
+        if (buf->cap - buf->len < BUFLEN + 1) {
+            char *data = (char *)realloc(buf->data, buf->cap * 2);
+            if (data == NULL) {
+                return memoryError(crawler);
+            }
+            buf->data = data;
+            buf->cap *= 2;
+        }
+        nbytes = recv(sockfd, buf->data + buf->len,
+                      limit > 0 && limit - buf->len < BUFLEN
+                          ? limit - buf->len
+                          : BUFLEN,
+                      0);
+        if (nbytes < 0) {
+            resourceError(crawler, "recv");
+            return -1;
+        }
+        if (nbytes == 0) {
+            break;
+        }
+        buf->len += nbytes;
+        buf->data[buf->len] = 0;
+        // check if it's a HTTP response
+        if (head_only && strstr(buf->data, "HTTP") != NULL) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/* --- check the availability of the external site ---
+ * a failure only means the host is invalid, so crawler->error is left as
+ * it was */
+static int check_offsite(crawler_t *crawler, char *host, int port) {
+    char port_str[16];
+    char request[HEADLEN];
+    char error[BUFLEN];
+    int valid = 0;
+
+    memcpy(error, crawler->error, sizeof(error));
+
+    // use port 80 as default (if port has not been specified)
+    snprintf(port_str, sizeof(port_str), "%d", port > 0 ? port : 80);
+    int sockfd = open_socket(crawler, host, port_str, OFFSITE_TIMEOUT);
+    if (sockfd < 0) {
+        // fail to get the address info -> invalid webserver there
+        memcpy(crawler->error, error, sizeof(error));
+        return 0;
+    }
+    struct timeval timeout = {OFFSITE_TIMEOUT, 0};
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    snprintf(request, sizeof(request), "HEAD / HTTP/1.0\r\n\r\n");
+    if (send_request(crawler, sockfd, request) == 0 &&
+        receive_response(crawler, sockfd, &crawler->head, true,
+                         crawler->config.max_response) >= 0 &&
+        strstr(crawler->head.data, "HTTP") != NULL) {
+        valid = 1;
+    }
+    close(sockfd);
+    memcpy(crawler->error, error, sizeof(error));
+    return valid;
+}
+
+/* ----- crawling ----- */
+
+static void handle_ref(void *ctx, int kind, char *path, char *host,
+                       int port) {
+    crawler_t *crawler = (crawler_t *)ctx;
+    crawler_callbacks_t *cb = &crawler->config.callbacks;
+
+    if (crawler->out_of_memory) {  // the step fails once parsing is done
+        return;
+    }
+
+    if (kind == REF_IMAGE) {
+        crawler_edge_t edge = {crawler->link, path, CRAWLER_EDGE_IMAGE,
+                               false};
+        if (search(crawler->img_table, hash_djb2(path)) == NULL) {
+            if (insert(crawler->img_table, path) < 0) {
+                crawler->out_of_memory = true;
+                return;
+            }
+            edge.first_seen = true;
+        }
+        if (cb->on_edge != NULL) {
+            cb->on_edge(cb->user, &edge);
+        }
+        return;
+    }
+
+    if (kind == REF_OFFSITE) {
+        // reported once the page has been parsed, so checking the host
+        // doesn't hold back the events of the page
+        if (crawler->n_pending == crawler->cap_pending) {
+            Offsite *pending = (Offsite *)realloc(
+                crawler->pending, crawler->cap_pending * 2 * sizeof(Offsite));
+            if (pending == NULL) {
+                crawler->out_of_memory = true;
+                return;
+            }
+            crawler->pending = pending;
+            crawler->cap_pending *= 2;
+        }
+        Offsite *offsite = &crawler->pending[crawler->n_pending];
+        offsite->host = strdup(host);
+        offsite->port = port;
+        offsite->path = strdup(path);
+        offsite->first_seen = false;
+        if (offsite->host == NULL || offsite->path == NULL) {
+            free(offsite->host);
+            free(offsite->path);
+            crawler->out_of_memory = true;
+            return;
+        }
+        crawler->n_pending++;
+        if (search(crawler->offsite_host_table, hash_djb2(host)) == NULL) {
+            if (insert(crawler->offsite_host_table, host) < 0) {
+                crawler->out_of_memory = true;
+                return;
+            }
+            offsite->first_seen = true;
+        }
+        return;
+    }
+
+    // a 30x without a Location header redirects to its first link
+    if (crawler->status_flag == 3 && crawler->redirect_dest == NULL &&
+        (crawler->redirect_dest = strdup(path)) == NULL) {
+        crawler->out_of_memory = true;
+        return;
+    }
+
+    crawler_edge_t edge = {crawler->link, path, CRAWLER_EDGE_PAGE, false};
+    if (search(crawler->page_table, hash_djb2(path)) == NULL) {
+        if (enqueue(crawler->queue, path) < 0 ||
+            insert(crawler->page_table, path) < 0) {
+            crawler->out_of_memory = true;
+            return;
+        }
+        edge.first_seen = true;
+    }
+    if (cb->on_edge != NULL) {
+        cb->on_edge(cb->user, &edge);
+    }
+}
+
+static void clear_offsite(crawler_t *crawler) {
+    for (int i = 0; i < crawler->n_pending; ++i) {
+        free(crawler->pending[i].host);
+        free(crawler->pending[i].path);
+    }
+    crawler->n_pending = 0;
+}
+
+// report the off-site links found on the page; each host is only checked
+// the first time it is seen, later links reuse the result
+static void report_offsite(crawler_t *crawler) {
+    crawler_callbacks_t *cb = &crawler->config.callbacks;
+
+    for (int i = 0; i < crawler->n_pending; ++i) {
+        Offsite *pending = &crawler->pending[i];
+        crawler_offsite_t offsite = {crawler->link, pending->host,
+                                     pending->port, pending->path, -1,
+                                     pending->first_seen};
+        if (crawler->config.check_offsite && pending->first_seen) {
+            offsite.valid = check_offsite(crawler, pending->host,
+                                          pending->port);
+            if (offsite.valid) {
+                insert(crawler->valid_host_table, pending->host);
+            }
+        } else if (crawler->config.check_offsite) {
+            offsite.valid = search(crawler->valid_host_table,
+                                   hash_djb2(pending->host)) != NULL;
+        }
+        if (cb->on_offsite != NULL) {
+            cb->on_offsite(cb->user, &offsite);
+        }
+    }
+    clear_offsite(crawler);
+}
+
+// emit the events of the response in crawler->response, fetched for
+// crawler->link; returns 1 or -1 if out of memory
+static int parse_page(crawler_t *crawler, bool truncated) {
+    crawler_callbacks_t *cb = &crawler->config.callbacks;
+    char *sp = crawler->response.data;
+    crawler_page_t page = {crawler->link, 0, -1, false, 0,
+                           crawler->response.len, truncated};
+
+    /* --- extract status --- */
+    crawler->status_flag = parse_status(&sp);
+    if (strncmp(sp, "HTTP/1.1 ", strlen("HTTP/1.1 ")) == 0) {
+        page.status = atoi(sp + strlen("HTTP/1.1 "));
+    }
+
+    /* --- extract the redirect target --- */
+    free(crawler->redirect_dest);
+    crawler->redirect_dest = NULL;
+    if (crawler->status_flag == 3) {
+        size_t len;
+        char *location = parse_location(sp, &len);
+        if (location != NULL &&
+            (crawler->redirect_dest = strndup(location, len)) == NULL) {
+            return memoryError(crawler);
+        }
+    }
+
+    /* --- extract dates and content-length --- */
+    if (crawler->status_flag == 2) {  // 30x and 404 pages are not real pages
+        page.has_last_modified =
+            parse_last_modified(&sp, &page.last_modified) == 0;
+        page.content_length = parse_content_length(&sp);
+    }
+    if (cb->on_page != NULL) {
+        cb->on_page(cb->user, &page);
+    }
+
+    if (crawler->status_flag == 4) {
+        // page not found
+        if (cb->on_not_found != NULL) {
+            cb->on_not_found(cb->user, crawler->link);
+        }
+        return 1;
+    }
+
+    /* --- extract links and images --- */
+    if (extract_refs(sp, crawler->link, crawler->host_name, &crawler->scratch,
+                     handle_ref, crawler) < 0 ||
+        crawler->out_of_memory) {
+        crawler->out_of_memory = false;
+        clear_offsite(crawler);
+        return memoryError(crawler);
+    }
+
+    if (crawler->status_flag == 3 && cb->on_redirect != NULL) {
+        crawler_redirect_t redirect = {crawler->link, crawler->redirect_dest};
+        cb->on_redirect(cb->user, &redirect);
+    }
+    report_offsite(crawler);
+
+    return 1;
+}
+
+// put the page back on the frontier after a failed request; returns -1
+static int requeue(crawler_t *crawler) {
+    if (enqueue(crawler->queue, crawler->link) < 0) {
+        memoryError(crawler);  // the page is lost
+    }
+    return -1;
+}
+
+int crawler_step(crawler_t *crawler) {
+    if (isEmpty(crawler->queue)) {
+        return 0;
+    }
+    // delay if it's not the initial request
+    if (!crawler->is_initial_request && crawler->config.delay_ms > 0) {
+        struct timespec delay = {crawler->config.delay_ms / 1000,
+                                 (crawler->config.delay_ms % 1000) * 1000000L};
+        nanosleep(&delay, NULL);
+    }
+    crawler->is_initial_request = false;
+
+    free(crawler->link);
+    crawler->link = dequeue(crawler->queue);
+
+    // send the request to the server and receive the reply
+    int sockfd = open_socket(crawler, crawler->host_name, crawler->port, 0);
+    if (sockfd < 0) {
+        return requeue(crawler);  // retried by the next step
+    }
+    size_t request_len = strlen(crawler->link) + HEADLEN;
+    char *request = (char *)malloc(request_len);
+    if (request == NULL) {
+        close(sockfd);
+        memoryError(crawler);
+        return requeue(crawler);
+    }
+    snprintf(request, request_len, "GET %s HTTP/1.0\r\n\r\n", crawler->link);
+    int received = -1;
+    if (send_request(crawler, sockfd, request) == 0) {
+        received = receive_response(crawler, sockfd, &crawler->response, false,
+                                    crawler->config.max_response);
+    }
+    free(request);
+    close(sockfd);
+    if (received < 0) {
+        return requeue(crawler);
+    }
+    return parse_page(crawler, received == 1);
+}
+
+int crawler_parse(crawler_t *crawler, const char *path, const char *response,
+                  long len) {
+    char *link = strdup(path);
+    if (link == NULL) {
+        return memoryError(crawler);
+    }
+    free(crawler->link);
+    crawler->link = link;
+    if (search(crawler->page_table, hash_djb2(link)) == NULL &&
+        insert(crawler->page_table, link) < 0) {
+        return memoryError(crawler);
+    }
+
+    Buffer *buf = &crawler->response;
+    if (buf->cap < len + 1) {
+        char *data = (char *)realloc(buf->data, len + 1);
+        if (data == NULL) {
+            return memoryError(crawler);
+        }
+        buf->data = data;
+        buf->cap = len + 1;
+    }
+    memcpy(buf->data, response, len);
+    buf->data[len] = 0;
+    buf->len = len;
+    return parse_page(crawler, false) < 0 ? -1 : 0;
+}
+
+int crawler_run(crawler_t *crawler) {
+    int status;
+
+    /* ----- apply BFS to recursively crawl the website ----- */
+    while ((status = crawler_step(crawler)) > 0) {
+    }
+    return status;
+}
+
+/* ----- JSONL sink ----- */
+
+static void json_string(FILE *fp, const char *str) {
+    if (str == NULL) {
+        fputs("null", fp);
+        return;
+    }
+    fputc('"', fp);
+    for (; *str != 0; ++str) {
+        unsigned char c = *str;
+        if (c == '"' || c == '\\') {
+            fprintf(fp, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(fp, "\\u%04x", c);
+        } else {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+void crawler_jsonl_page(void *fp, const crawler_page_t *page) {
+    fputs("{\"type\":\"page\",\"path\":", fp);
+    json_string(fp, page->path);
+    fprintf(fp, ",\"status\":%d,\"bytes\":%ld,\"truncated\":%s",
+            page->status, page->bytes, page->truncated ? "true" : "false");
+    fputs(",\"content_length\":", fp);
+    if (page->content_length >= 0) {
+        fprintf(fp, "%d", page->content_length);
+    } else {
+        fputs("null", fp);
+    }
+    fputs(",\"last_modified\":", fp);
+    if (page->has_last_modified) {
+        fprintf(fp, "%lld", (long long)page->last_modified);
+    } else {
+        fputs("null", fp);
+    }
+    fputs("}\n", fp);
+    fflush(fp);
+}
+
+void crawler_jsonl_edge(void *fp, const crawler_edge_t *edge) {
+    fputs("{\"type\":\"edge\",\"from\":", fp);
+    json_string(fp, edge->from);
+    fputs(",\"to\":", fp);
+    json_string(fp, edge->to);
+    fprintf(fp, ",\"kind\":\"%s\",\"first_seen\":%s}\n",
+            edge->kind == CRAWLER_EDGE_IMAGE ? "image" : "page",
+            edge->first_seen ? "true" : "false");
+    fflush(fp);
+}
+
+void crawler_jsonl_redirect(void *fp, const crawler_redirect_t *redirect) {
+    fputs("{\"type\":\"redirect\",\"from\":", fp);
+    json_string(fp, redirect->from);
+    fputs(",\"to\":", fp);
+    json_string(fp, redirect->to);
+    fputs("}\n", fp);
+    fflush(fp);
+}
+
+void crawler_jsonl_not_found(void *fp, const char *path) {
+    fputs("{\"type\":\"not_found\",\"path\":", fp);
+    json_string(fp, path);
+    fputs("}\n", fp);
+    fflush(fp);
+}
+
+void crawler_jsonl_offsite(void *fp, const crawler_offsite_t *offsite) {
+    fputs("{\"type\":\"offsite\",\"from\":", fp);
+    json_string(fp, offsite->from);
+    fputs(",\"host\":", fp);
+    json_string(fp, offsite->host);
+    fputs(",\"port\":", fp);
+    if (offsite->port > 0) {
+        fprintf(fp, "%d", offsite->port);
+    } else {
+        fputs("null", fp);
+    }
+    fputs(",\"path\":", fp);
+    json_string(fp, offsite->path);
+    fprintf(fp, ",\"valid\":%s,\"first_seen\":%s}\n",
+            offsite->valid < 0 ? "null" : offsite->valid ? "true" : "false",
+            offsite->first_seen ? "true" : "false");
+    fflush(fp);
+}
+
+crawler_callbacks_t crawler_jsonl_sink(FILE *fp) {
+    crawler_callbacks_t cb = {crawler_jsonl_page, crawler_jsonl_edge,
+                              crawler_jsonl_redirect, crawler_jsonl_not_found,
+                              crawler_jsonl_offsite, fp};
+    return cb;
+}
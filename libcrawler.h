@@ -0,0 +1,114 @@
+#ifndef LIBCRAWLER_H
+#define LIBCRAWLER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+/* ----- events streamed while crawling -----
+ * strings are only valid for the duration of the callback, copy them if
+ * they need to outlive it */
+
+typedef struct crawler_page_t {  // a page that has been fetched
+    const char *path;
+    int status;          // e.g. 200, 301, 404 (0 if there is no status line)
+    int content_length;  // -1 if not reported (only parsed for 2xx pages)
+    bool has_last_modified;
+    time_t last_modified;
+    long bytes;      // size of the whole response, as far as it was read
+    bool truncated;  // cut off at max_response bytes
+} crawler_page_t;
+
+#define CRAWLER_EDGE_PAGE 0
+#define CRAWLER_EDGE_IMAGE 1
+
+typedef struct crawler_edge_t {  // an on-site link or image on a page
+    const char *from;
+    const char *to;
+    int kind;         // CRAWLER_EDGE_PAGE or CRAWLER_EDGE_IMAGE
+    bool first_seen;  // to has not been seen on any earlier page
+} crawler_edge_t;
+
+typedef struct crawler_redirect_t {  // a 30x page and its target
+    const char *from;
+    // the Location header as sent, which may be a full URL; the first
+    // on-site link of the page if there is no Location, or NULL if neither
+    const char *to;
+} crawler_redirect_t;
+
+typedef struct crawler_offsite_t {  // a link to another host
+    const char *from;
+    const char *host;
+    int port;  // -1 if it has not been specified
+    const char *path;
+    int valid;        // 1 or 0 if check_offsite is set, -1 otherwise
+    bool first_seen;  // host has not been linked from any earlier page
+} crawler_offsite_t;
+
+typedef struct crawler_callbacks_t {  // any of these may be NULL
+    void (*on_page)(void *user, const crawler_page_t *page);
+    void (*on_edge)(void *user, const crawler_edge_t *edge);
+    void (*on_redirect)(void *user, const crawler_redirect_t *redirect);
+    void (*on_not_found)(void *user, const char *path);
+    void (*on_offsite)(void *user, const crawler_offsite_t *offsite);
+    void *user;
+} crawler_callbacks_t;
+
+typedef struct crawler_config_t {
+    const char *host_name;
+    const char *port;
+    int delay_ms;        // politeness delay between two requests
+    bool check_offsite;  // send a HEAD request to each off-site host found,
+                         // after the other events of the page (connecting
+                         // and reading each time out after 5 seconds)
+    long max_response;   // bytes kept of a response, the rest is dropped
+                         // (8 MiB by default, 0 for no limit)
+    crawler_callbacks_t callbacks;
+} crawler_config_t;
+
+typedef struct crawler_t crawler_t;
+
+// fill in the defaults (port 80, 500ms delay, off-site hosts not checked,
+// responses cut off at 8 MiB)
+void crawler_config_init(crawler_config_t *config);
+
+// returns NULL if the config is incomplete or out of memory
+crawler_t *crawler_new(const crawler_config_t *config);
+
+// fetch and parse the next page of the frontier;
+// returns 1 if a page was crawled, 0 once the frontier is empty and -1 on
+// a network error or when out of memory (see crawler_error()). After a
+// network error the page goes back to the end of the frontier and no event
+// is emitted for it, so stepping again is supported and retries it later.
+// Running out of memory while parsing a page stops the page there, its
+// events so far have been emitted and it is not retried
+int crawler_step(crawler_t *crawler);
+
+// parse a response fetched by other means (e.g. recorded) as the page at
+// path, emitting the same events as crawler_step(); the links found join the
+// frontier. response holds len bytes, status line and headers included;
+// returns 0 or -1 if out of memory
+int crawler_parse(crawler_t *crawler, const char *path, const char *response,
+                  long len);
+
+// step until the frontier is empty; returns 0 or -1 as crawler_step(),
+// after which crawler_run() or crawler_step() can resume the crawl
+int crawler_run(crawler_t *crawler);
+
+const char *crawler_error(crawler_t *crawler);
+
+void crawler_free(crawler_t *crawler);
+
+/* ----- JSONL sink -----
+ * writes one JSON object per event to fp and flushes it, so results can be
+ * consumed while the crawl is running */
+
+crawler_callbacks_t crawler_jsonl_sink(FILE *fp);
+
+void crawler_jsonl_page(void *fp, const crawler_page_t *page);
+void crawler_jsonl_edge(void *fp, const crawler_edge_t *edge);
+void crawler_jsonl_redirect(void *fp, const crawler_redirect_t *redirect);
+void crawler_jsonl_not_found(void *fp, const char *path);
+void crawler_jsonl_offsite(void *fp, const crawler_offsite_t *offsite);
+
+#endif
@@ -0,0 +1,243 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REF_PAGE 0     // on-site page link
+#define REF_IMAGE 1    // image, resolved against the folder of the page
+#define REF_OFFSITE 2  // link to another host
+
+// called once for every link or image found on a page; host and port are
+// only meaningful for REF_OFFSITE (port is -1 if it has not been specified)
+typedef void (*ref_handler)(void *ctx, int kind, char *path, char *host,
+                            int port);
+
+// copy [lp, rp) into dst, truncated to fit in size bytes
+static void copy_span(char *dst, size_t size, char *lp, char *rp) {
+    size_t n = rp - lp;
+    if (n > size - 1) {
+        n = size - 1;
+    }
+    memcpy(dst, lp, n);
+    dst[n] = 0;
+}
+
+/* --- extract status ---
+ * returns the status class (2, 3 or 4; 2 if the status line is missing) and
+ * leaves *sp behind the status line so headers can be parsed from there */
+static int parse_status(char **sp) {
+    char *recog_http = "HTTP/1.1 ";
+    char *lp, *rp;
+    char status[4] = {0};
+
+    lp = strstr(*sp, recog_http);
+    if (lp == NULL) {
+        return 2;
+    }
+    *sp = lp;
+    lp += strlen(recog_http);
+    for (rp = lp; *rp != ' ' && *rp != 0 && rp - lp < 3; ++rp) {
+    }
+    memcpy(status, lp, rp - lp);
+
+    if (strcmp(status, "404") == 0) {
+        return 4;
+    } else if (strcmp(status, "301") == 0 || strcmp(status, "302") == 0) {
+        return 3;
+    }
+    return 2;
+}
+
+/* --- extract last-modified ---
+ * returns 0 and fills *t on success, -1 if the header is missing or the
+ * date cannot be parsed */
+static int parse_last_modified(char **sp, time_t *t) {
+    char *recog_modified = "Last-Modified: ";
+    char *hp, *lp, *rp;
+    char date[32] = {0};
+
+    hp = strstr(*sp, recog_modified);
+    if (hp == NULL) {
+        return -1;
+    }
+    lp = hp + strlen(recog_modified) + 5;  // skip the week day, e.g. "Mon, "
+    rp = strstr(hp, "GMT");
+    if (rp == NULL || rp - 1 <= lp || rp - 1 - lp >= sizeof(date)) {
+        return -1;
+    }
+    *sp = hp;
+    memcpy(date, lp, rp - 1 - lp);
+
+    struct tm tm = {0};
+    if (strptime(date, "%d %b %Y %H:%M:%S", &tm) == NULL) {
+        return -1;
+    }
+    *t = timegm(&tm);  // the date is in GMT
+    return 0;
+}
+
+/* --- extract content-length ---
+ * returns the length, or -1 if the header is missing */
+static int parse_content_length(char **sp) {
+    char *recog_length = "Content-Length: ";
+    char *lp = strstr(*sp, recog_length);
+
+    if (lp == NULL) {
+        return -1;
+    }
+    *sp = lp;
+    return atoi(lp + strlen(recog_length));
+}
+
+/* --- extract location ---
+ * returns the value of the Location header and sets *len to its length, or
+ * NULL if the headers of the response have no Location */
+static char *parse_location(char *sp, size_t *len) {
+    char *recog_location = "\r\nLocation: ";
+    char *lp = strstr(sp, recog_location);
+    char *end = strstr(sp, "\r\n\r\n");  // end of the headers
+    char *rp;
+
+    if (lp == NULL || (end != NULL && lp >= end)) {
+        return NULL;
+    }
+    lp += strlen(recog_location);
+    for (rp = lp; *rp != '\r' && *rp != '\n' && *rp != 0; ++rp) {
+    }
+    *len = rp - lp;
+    return lp;
+}
+
+// scratch space for extract_refs(), grows to fit the longest href seen
+typedef struct Ref_Buffer {
+    char *data;
+    size_t cap;
+} Ref_Buffer;
+
+// make room for size bytes; returns -1 if out of memory
+static int reserve(Ref_Buffer *buf, size_t size) {
+    if (size <= buf->cap) {
+        return 0;
+    }
+    size_t cap = buf->cap > 0 ? buf->cap : 256;
+    while (cap < size) {
+        cap *= 2;
+    }
+    char *data = (char *)realloc(buf->data, cap);
+    if (data == NULL) {
+        return -1;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return 0;
+}
+
+/* --- extract links and images ---
+ * scans from sp to the end of the response; link is the path of the page
+ * being parsed and host_name the site being crawled. Paths are copied into
+ * scratch, which grows so long links are passed on whole; an href that is
+ * cut off by the end of the response is dropped.
+ * returns 0, or -1 if scratch cannot grow */
+static int extract_refs(char *sp, char *link, char *host_name,
+                        Ref_Buffer *scratch, ref_handler handler,
+                        void *ctx) {
+    char *recog_link = "<a href=\"";
+    char *recog_img = "<img src=\"";
+    char *lp, *rp;
+
+    // the folder containing the page, images are relative to it
+    size_t folder_len = 1;  // *link should be '/'
+    for (rp = link + 1; *rp != 0; ++rp) {
+        if (*rp == '/') {  // it's under a folder
+            folder_len = rp - link + 1;
+        }
+    }
+
+    while (true) {
+        char *ti = strstr(sp, recog_img);   // temp pointer for img
+        char *tl = strstr(sp, recog_link);  // temp pointer for link
+
+        if (ti != NULL && tl != NULL) {
+            sp = ti < tl ? ti : tl;
+        } else if (tl != NULL) {
+            sp = tl;
+        } else if (ti != NULL) {
+            sp = ti;
+        } else {  // no more links or images on the page
+            break;
+        }
+
+        lp = sp + strlen(sp == ti ? recog_img : recog_link);
+        for (rp = lp; *rp != '"' && *rp != 0; ++rp) {
+        }
+        if (*rp == 0) {  // no closing quote, the response was cut off
+            break;
+        }
+
+        if (sp == ti) {
+            // extract the image path
+            if (reserve(scratch, folder_len + (rp - lp) + 1) < 0) {
+                return -1;
+            }
+            char *image = scratch->data;
+            memcpy(image, link, folder_len);
+            copy_span(image + folder_len, rp - lp + 1, lp, rp);
+            handler(ctx, REF_IMAGE, image, NULL, -1);
+            sp = rp;
+            continue;
+        }
+
+        // analyse and filter the link
+        char *end = rp;  // closing quote of the href
+        size_t size = end - lp + 2;  // room for a leading '/' and the NUL
+        if (reserve(scratch, size * 2) < 0) {
+            return -1;
+        }
+        char *local_host = scratch->data;
+        char *local_link = scratch->data + size;
+        int port = -1;
+
+        local_host[0] = 0;
+        char *proto = NULL;
+        for (char *p = lp; p + 1 < end; ++p) {
+            if (*p == '/' && *(p + 1) == '/') {
+                // the link includes "http(s)://"
+                proto = p + 2;
+                break;
+            }
+        }
+
+        if (proto != NULL) {
+            lp = proto;
+            for (rp = lp; rp < end && *rp != ':' && *rp != '/'; ++rp) {
+            }
+            copy_span(local_host, size, lp, rp);  // local_host <- host_name
+            if (rp < end && *rp == ':') {  // port has been specified
+                lp = rp + 1;
+                for (rp = lp; rp < end && *rp != '/'; ++rp) {
+                }
+                if (rp > lp) {
+                    port = atoi(lp);
+                }
+            }
+            copy_span(local_link, size, rp, end);
+        } else if (*lp != '/') {
+            local_link[0] = '/';
+            copy_span(local_link + 1, size - 1, lp, end);
+        } else {
+            copy_span(local_link, size, lp, end);
+        }
+
+        sp = end;
+
+        if (proto != NULL && strcmp(local_host, host_name) != 0) {
+            // offsite urls
+            handler(ctx, REF_OFFSITE, local_link, local_host, port);
+        } else if (local_link[0] == 0) {  // e.g. "http://host_name"
+            handler(ctx, REF_PAGE, "/", NULL, -1);
+        } else {
+            handler(ctx, REF_PAGE, local_link, NULL, -1);
+        }
+    }
+    return 0;
+}
@@ -7,41 +7,77 @@ typedef struct Queue {
     char **links;
 } Queue;
 
-Queue *init_queue(unsigned capacity) {
+// returns NULL if out of memory
+static Queue *init_queue(unsigned capacity) {
     Queue *queue = (Queue *)malloc(sizeof(Queue));
+    if (queue == NULL) {
+        return NULL;
+    }
     queue->capacity = capacity;
     queue->front = queue->size = 0;
     queue->rear = capacity - 1;
     queue->links = malloc(queue->capacity * sizeof(char *));
+    if (queue->links == NULL) {
+        free(queue);
+        return NULL;
+    }
 
     return queue;
 }
 
-int isFull(Queue *queue) { return queue->size == queue->capacity; }
+static int isFull(Queue *queue) { return queue->size == queue->capacity; }
 
-int isEmpty(Queue *queue) { return queue->size == 0; }
+static int isEmpty(Queue *queue) { return queue->size == 0; }
 
-void enqueue(Queue *queue, char *link) {
-    if (isFull(queue)) {
-        return;
+// returns -1 if out of memory, the queue is left unchanged then
+static int enqueue(Queue *queue, char *link) {
+    char *copy = (char *)malloc((strlen(link) + 1) * sizeof(char));
+    if (copy == NULL) {
+        return -1;
+    }
+    strcpy(copy, link);
+
+    if (isFull(queue)) {  // double it, unwrapping the links to the front
+        unsigned capacity = queue->capacity > 0 ? queue->capacity * 2 : 1;
+        char **links = malloc(capacity * sizeof(char *));
+        if (links == NULL) {
+            free(copy);
+            return -1;
+        }
+        for (int i = 0; i < queue->size; ++i) {
+            links[i] = queue->links[(queue->front + i) % queue->capacity];
+        }
+        free(queue->links);
+        queue->links = links;
+        queue->capacity = capacity;
+        queue->front = 0;
+        queue->rear = queue->size - 1;
     }
     queue->rear = (queue->rear + 1) % queue->capacity;
-    queue->links[queue->rear] = (char *)malloc(128 * sizeof(char));
-    strcpy(queue->links[queue->rear], link);
+    queue->links[queue->rear] = copy;
     queue->size++;
+    return 0;
 }
 
-char *dequeue(Queue *queue) {
+// returns NULL if the queue is empty; the caller owns the link
+static char *dequeue(Queue *queue) {
     if (isEmpty(queue)) {
         return NULL;
     }
 
-    char *d = queue->links[queue->front];
-    char *link = (char *)malloc(strlen(d) * sizeof(char));
-    strcpy(link, d);
-    free(d);
+    char *link = queue->links[queue->front];
     queue->front = (queue->front + 1) % queue->capacity;
     queue->size--;
 
     return link;
+}
+
+static void free_queue(Queue *queue) {
+    while (!isEmpty(queue)) {
+        free(queue->links[queue->front]);
+        queue->front = (queue->front + 1) % queue->capacity;
+        queue->size--;
+    }
+    free(queue->links);
+    free(queue);
 }
\ No newline at end of file